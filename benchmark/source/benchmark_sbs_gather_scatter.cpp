@@ -0,0 +1,178 @@
+#include "benchmark/benchmark.h"
+
+#include "sbs_gather_scatter.hpp"
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+    // well past the size of any last level cache, so (nearly) every access is a miss
+    constexpr size_t table_bytes = size_t{1} << 29;
+
+    // each iteration reads a fresh window of this, so a run doesn't keep hitting the same (now cached) rows
+    constexpr size_t index_pool_size = size_t{1} << 22;
+
+    template <typename T>
+    std::vector<T>& table() {
+        static std::vector<T> instance = [](){
+            std::vector<T> result(table_bytes / sizeof(T));
+            std::iota(result.begin(), result.end(), T{0});
+            return result;
+        }();
+
+        return instance;
+    }
+
+    template <typename T>
+    const std::vector<uint32_t>& index_pool() {
+        static const std::vector<uint32_t> instance = [](){
+            std::mt19937 generator{42};
+            std::uniform_int_distribution<uint32_t> distribution{0, static_cast<uint32_t>(table<T>().size() - 1)};
+
+            std::vector<uint32_t> result(index_pool_size);
+            for(auto& index : result) {
+                index = distribution(generator);
+            }
+
+            return result;
+        }();
+
+        return instance;
+    }
+
+    // a non-owning view over part of the index pool, since gather / scatter just need data() and size()
+    struct index_window final {
+        const uint32_t* m_data;
+        size_t m_size;
+
+        const uint32_t* data() const noexcept { return m_data; }
+        size_t size() const noexcept { return m_size; }
+    };
+
+    class window_cursor final {
+    public:
+        explicit window_cursor(const std::vector<uint32_t>& pool) noexcept : m_pool(pool), m_offset(0) { }
+
+        index_window next(const size_t count) noexcept {
+            if(m_offset + count > m_pool.size()) {
+                m_offset = 0;
+            }
+
+            const index_window result{m_pool.data() + m_offset, count};
+            m_offset += count;
+            return result;
+        }
+
+    private:
+        const std::vector<uint32_t>& m_pool;
+        size_t m_offset;
+    };
+
+    void gather_scatter_args(benchmark::internal::Benchmark* const benchmark) {
+        for(const auto count : {64, 256, 1024}) {
+            for(const auto distance : {0, 4, 8, 16, 32, 64}) {
+                benchmark->Args({count, distance});
+            }
+        }
+    }
+
+    void loop_args(benchmark::internal::Benchmark* const benchmark) {
+        for(const auto count : {64, 256, 1024}) {
+            benchmark->Args({count});
+        }
+    }
+}
+
+template <typename T>
+void BM_gather_loop(benchmark::State& state) {
+    const auto& src = table<T>();
+    window_cursor cursor{index_pool<T>()};
+
+    const auto task = [&src, &cursor, count = static_cast<size_t>(state.range(0))](){
+        const auto indices = cursor.next(count);
+        sbs::unscoped_stack_vector<T> rows(count, count);
+
+        for(size_t i = 0; i < count; ++i) {
+            rows[i] = src[indices.data()[i]];
+        }
+
+        benchmark::DoNotOptimize(rows.data());
+        benchmark::ClobberMemory();
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+template <typename T>
+void BM_gather_sbs(benchmark::State& state) {
+    const auto& src = table<T>();
+    window_cursor cursor{index_pool<T>()};
+
+    const auto task = [&src, &cursor, count = static_cast<size_t>(state.range(0)),
+                       distance = static_cast<size_t>(state.range(1))](){
+        const auto indices = cursor.next(count);
+        sbs::unscoped_stack_vector<T> rows(count, count);
+
+        sbs::gather(src, indices, rows, distance);
+
+        benchmark::DoNotOptimize(rows.data());
+        benchmark::ClobberMemory();
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+template <typename T>
+void BM_scatter_loop(benchmark::State& state) {
+    auto& dst = table<T>();
+    window_cursor cursor{index_pool<T>()};
+
+    const auto task = [&dst, &cursor, count = static_cast<size_t>(state.range(0))](){
+        const auto indices = cursor.next(count);
+        sbs::unscoped_stack_vector<T> rows(count, count);
+        benchmark::DoNotOptimize(rows.data());
+
+        for(size_t i = 0; i < count; ++i) {
+            dst[indices.data()[i]] = rows[i];
+        }
+
+        benchmark::ClobberMemory();
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+template <typename T>
+void BM_scatter_sbs(benchmark::State& state) {
+    auto& dst = table<T>();
+    window_cursor cursor{index_pool<T>()};
+
+    const auto task = [&dst, &cursor, count = static_cast<size_t>(state.range(0)),
+                       distance = static_cast<size_t>(state.range(1))](){
+        const auto indices = cursor.next(count);
+        sbs::unscoped_stack_vector<T> rows(count, count);
+        benchmark::DoNotOptimize(rows.data());
+
+        sbs::scatter(rows, indices, dst, distance);
+
+        benchmark::ClobberMemory();
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_gather_loop, uint32_t)->Apply(loop_args);
+BENCHMARK_TEMPLATE(BM_gather_sbs, uint32_t)->Apply(gather_scatter_args);
+BENCHMARK_TEMPLATE(BM_gather_loop, uint64_t)->Apply(loop_args);
+BENCHMARK_TEMPLATE(BM_gather_sbs, uint64_t)->Apply(gather_scatter_args);
+BENCHMARK_TEMPLATE(BM_scatter_loop, uint64_t)->Apply(loop_args);
+BENCHMARK_TEMPLATE(BM_scatter_sbs, uint64_t)->Apply(gather_scatter_args);
@@ -0,0 +1,166 @@
+#include "benchmark/benchmark.h"
+
+#include "sbs_unscoped_stack_pool.hpp"
+
+#include <list>
+#include <map>
+
+namespace {
+    struct TreeNode final {
+        int key;
+        TreeNode* left = nullptr;
+        TreeNode* right = nullptr;
+
+        TreeNode(int k) : key(k) {}
+    };
+
+    // a cheap, deterministic key sequence so the trees aren't degenerate
+    int key_at(const int i) {
+        return static_cast<int>((static_cast<unsigned>(i) * 2654435761U) >> 8);
+    }
+
+    template <typename Create>
+    TreeNode* build_tree(const int count, Create&& create) {
+        TreeNode* root = nullptr;
+
+        for(int i = 0; i < count; ++i) {
+            const auto key = key_at(i);
+            TreeNode** target = &root;
+            while(*target != nullptr) {
+                target = key < (*target)->key ? &(*target)->left : &(*target)->right;
+            }
+
+            *target = create(key);
+        }
+
+        return root;
+    }
+
+    long long sum_tree(const TreeNode* const node) {
+        return node == nullptr ? 0 : node->key + sum_tree(node->left) + sum_tree(node->right);
+    }
+
+    void delete_tree(TreeNode* const node) {
+        if(node != nullptr) {
+            delete_tree(node->left);
+            delete_tree(node->right);
+            delete node;
+        }
+    }
+
+    template <typename List>
+    long long build_and_sum_list(List& instance, const int count) {
+        for(int i = 0; i < count; ++i) {
+            instance.push_back(i);
+        }
+
+        long long sum = 0;
+        for(const auto value : instance) {
+            sum += value;
+        }
+
+        return sum;
+    }
+
+    template <typename Map>
+    long long build_and_sum_map(Map& instance, const int count) {
+        for(int i = 0; i < count; ++i) {
+            instance.emplace(key_at(i), i);
+        }
+
+        long long sum = 0;
+        for(const auto& entry : instance) {
+            sum += entry.second;
+        }
+
+        return sum;
+    }
+}
+
+void BM_tree_new(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        TreeNode* const root = build_tree(count, [](const int key){ return new TreeNode(key); });
+        benchmark::DoNotOptimize(sum_tree(root));
+        delete_tree(root);
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+void BM_tree_usp(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        sbs::unscoped_stack_pool<TreeNode> pool(static_cast<size_t>(count));
+        TreeNode* const root = build_tree(count, [&pool](const int key){ return pool.emplace(key); });
+        benchmark::DoNotOptimize(sum_tree(root));
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+void BM_list_std_allocator(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        std::list<int> instance;
+        benchmark::DoNotOptimize(build_and_sum_list(instance, count));
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+void BM_list_usp(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        using node_t = sbs::unscoped_stack_pool_node<int>;
+        using allocator_t = sbs::unscoped_stack_pool_allocator<int, node_t>;
+
+        // two spare nodes, since some implementations allocate the list's sentinel, and MSVC debug builds
+        // also allocate a container proxy
+        sbs::unscoped_stack_pool<node_t> pool(static_cast<size_t>(count) + 2);
+        std::list<int, allocator_t> instance{allocator_t{pool}};
+        benchmark::DoNotOptimize(build_and_sum_list(instance, count));
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+void BM_map_std_allocator(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        std::map<int, int> instance;
+        benchmark::DoNotOptimize(build_and_sum_map(instance, count));
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+void BM_map_usp(benchmark::State& state) {
+    const auto task = [count = static_cast<int>(state.range(0))](){
+        using value_t = std::pair<const int, int>;
+        using node_t = sbs::unscoped_stack_pool_node<value_t>;
+        using allocator_t = sbs::unscoped_stack_pool_allocator<value_t, node_t>;
+
+        // two spare nodes, since some implementations allocate the tree's header, and MSVC debug builds
+        // also allocate a container proxy
+        sbs::unscoped_stack_pool<node_t> pool(static_cast<size_t>(count) + 2);
+        std::map<int, int, std::less<int>, allocator_t> instance{allocator_t{pool}};
+        benchmark::DoNotOptimize(build_and_sum_map(instance, count));
+    };
+
+    for(auto _ : state) {
+        task();
+    }
+}
+
+BENCHMARK(BM_tree_new)->Range(8, 1024);
+BENCHMARK(BM_tree_usp)->Range(8, 1024);
+BENCHMARK(BM_list_std_allocator)->Range(8, 1024);
+BENCHMARK(BM_list_usp)->Range(8, 1024);
+BENCHMARK(BM_map_std_allocator)->Range(8, 1024);
+BENCHMARK(BM_map_usp)->Range(8, 1024);
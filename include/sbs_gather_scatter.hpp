@@ -0,0 +1,313 @@
+#pragma once
+
+#include "sbs_unscoped_stack_vector.hpp"
+
+// The hardware gather / scatter instructions touch the same cache lines as the plain loop, so they save instructions
+// rather than cache misses, and neither beat the plain loop on the (cache missing) benchmarks. They're opt-in:
+// define these to 1 to use them. Prefetching, which is where the gains are, doesn't depend on them.
+#ifndef SBS_ENABLE_SIMD_GATHER
+#define SBS_ENABLE_SIMD_GATHER 0
+#endif // SBS_ENABLE_SIMD_GATHER
+
+#ifndef SBS_ENABLE_SIMD_SCATTER
+#define SBS_ENABLE_SIMD_SCATTER 0
+#endif // SBS_ENABLE_SIMD_SCATTER
+
+// whether the SIMD kernels are needed at all, given the instruction sets enabled at compile time
+#if (SBS_ENABLE_SIMD_GATHER && (defined(__AVX2__) || defined(__AVX512F__))) \
+    || (SBS_ENABLE_SIMD_SCATTER && defined(__AVX512F__))
+#define SBS_SIMD_KERNELS 1
+#endif
+
+#if SBS_SIMD_KERNELS || defined(WIN32)
+#include <immintrin.h>
+#endif
+
+#ifdef WIN32
+// MSVC has no write hint, so both flavours prefetch for reading
+#define SBS_PREFETCH_READ(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#define SBS_PREFETCH_WRITE(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define SBS_PREFETCH_READ(address) __builtin_prefetch((address), 0, 3)
+#define SBS_PREFETCH_WRITE(address) __builtin_prefetch((address), 1, 3)
+#endif
+
+#include <cstddef>
+#include <type_traits>
+
+namespace sbs {
+    //! \brief  How many elements ahead gather / scatter prefetch by default.
+    //! \note   Each element is (usually) its own cache miss, so this wants to be roughly memory latency divided by
+    //!         the time spent per element. Out-of-order cores already overlap a plain gather's independent loads
+    //!         well, so the big win is scatter, where stores would otherwise stall on the store buffer; 16 - 64 all
+    //!         did well on the benchmarks, but it's worth tuning for your hardware.
+    inline constexpr std::size_t default_prefetch_distance = 16;
+
+    namespace detail {
+        //! \brief  Whether gather / scatter can use the SIMD kernels for these types.
+        template <typename T, typename Index>
+        inline constexpr bool is_simd_gatherable_v = std::is_trivially_copyable_v<T>
+                                                  && (sizeof(T) == 4 || sizeof(T) == 8)
+                                                  && std::is_integral_v<Index>
+                                                  && (sizeof(Index) == 4 || sizeof(Index) == 8);
+
+        //! \brief  Prefetches the elements indices[first, last) will touch.
+        template <bool ForWrite, typename T, typename Index>
+        FORCE_INLINE void prefetch_indexed(const T* const table,
+                                           const Index* const indices,
+                                           const std::size_t first,
+                                           const std::size_t last) noexcept
+        {
+            for(std::size_t i = first; i < last; ++i) {
+                if constexpr (ForWrite) {
+                    SBS_PREFETCH_WRITE(table + indices[i]);
+                } else {
+                    SBS_PREFETCH_READ(table + indices[i]);
+                }
+            }
+        }
+
+        //! \brief  The plain loop, with prefetching. Handles everything the SIMD kernels don't.
+        template <typename T, typename Index>
+        FORCE_INLINE void gather_scalar(const T* const src,
+                                        const Index* const indices,
+                                        T* const dst,
+                                        std::size_t first,
+                                        const std::size_t count,
+                                        const std::size_t prefetch_distance)
+        {
+            // split so the loop that prefetches doesn't need to check it's still in range
+            const auto prefetch_end = count > prefetch_distance ? count - prefetch_distance : 0;
+
+            for(; prefetch_distance != 0 && first < prefetch_end; ++first) {
+                SBS_PREFETCH_READ(src + indices[first + prefetch_distance]);
+                dst[first] = src[indices[first]];
+            }
+
+            for(; first < count; ++first) {
+                dst[first] = src[indices[first]];
+            }
+        }
+
+        template <typename T, typename Index>
+        FORCE_INLINE void scatter_scalar(const T* const src,
+                                         const Index* const indices,
+                                         T* const dst,
+                                         std::size_t first,
+                                         const std::size_t count,
+                                         const std::size_t prefetch_distance)
+        {
+            const auto prefetch_end = count > prefetch_distance ? count - prefetch_distance : 0;
+
+            for(; prefetch_distance != 0 && first < prefetch_end; ++first) {
+                SBS_PREFETCH_WRITE(dst + indices[first + prefetch_distance]);
+                dst[indices[first]] = src[first];
+            }
+
+            for(; first < count; ++first) {
+                dst[indices[first]] = src[first];
+            }
+        }
+
+#if SBS_SIMD_KERNELS
+        // The kernels below always use 64-bit index lanes: it means unsigned 32-bit indices (which the gather
+        // instructions would otherwise treat as signed) work, and one code path covers every supported combination.
+
+#if defined(__AVX512F__)
+        inline constexpr std::size_t simd_lanes = 8;
+
+        template <typename Index>
+        FORCE_INLINE __m512i load_indices(const Index* const indices) noexcept
+        {
+            // the all-lanes masked forms are used throughout, since the unmasked ones start from an undefined
+            // register, which some GCC versions warn about (and this builds with -Werror)
+            if constexpr (sizeof(Index) == 8) {
+                return _mm512_loadu_si512(indices);
+            } else if constexpr (std::is_signed_v<Index>) {
+                return _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)));
+            } else {
+                return _mm512_maskz_cvtepu32_epi64(0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)));
+            }
+        }
+
+        template <typename T, typename Index>
+        FORCE_INLINE void gather_block(const T* const src, const Index* const indices, T* const dst) noexcept
+        {
+            const auto lanes = load_indices(indices);
+
+            if constexpr (sizeof(T) == 8) {
+                _mm512_storeu_si512(dst, _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, lanes, src, 8));
+            } else {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                                    _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xFF, lanes, src, 4));
+            }
+        }
+
+        //! \note   Lanes are written in order, so repeated indices end up with the last value, same as the plain loop.
+        template <typename T, typename Index>
+        FORCE_INLINE void scatter_block(const T* const src, const Index* const indices, T* const dst) noexcept
+        {
+            const auto lanes = load_indices(indices);
+
+            if constexpr (sizeof(T) == 8) {
+                _mm512_i64scatter_epi64(dst, lanes, _mm512_loadu_si512(src), 8);
+            } else {
+                _mm512_i64scatter_epi32(dst, lanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), 4);
+            }
+        }
+
+        inline constexpr bool has_simd_scatter = true;
+#else
+        inline constexpr std::size_t simd_lanes = 4;
+
+        template <typename Index>
+        FORCE_INLINE __m256i load_indices(const Index* const indices) noexcept
+        {
+            if constexpr (sizeof(Index) == 8) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices));
+            } else if constexpr (std::is_signed_v<Index>) {
+                return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)));
+            } else {
+                return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)));
+            }
+        }
+
+        template <typename T, typename Index>
+        FORCE_INLINE void gather_block(const T* const src, const Index* const indices, T* const dst) noexcept
+        {
+            const auto lanes = load_indices(indices);
+
+            if constexpr (sizeof(T) == 8) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                                    _mm256_i64gather_epi64(reinterpret_cast<const long long*>(src), lanes, 8));
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                                 _mm256_i64gather_epi32(reinterpret_cast<const int*>(src), lanes, 4));
+            }
+        }
+
+        // AVX2 has no scatter instruction
+        inline constexpr bool has_simd_scatter = false;
+#endif // __AVX512F__
+
+        template <bool IsScatter, typename T, typename Index>
+        FORCE_INLINE std::size_t simd_blocks(const T* const src,
+                                             const Index* const indices,
+                                             T* const dst,
+                                             const std::size_t count,
+                                             const std::size_t prefetch_distance) noexcept
+        {
+            const auto blocks_end = count - count % simd_lanes;
+            const T* const table = IsScatter ? dst : src;
+
+            std::size_t i = 0;
+            for(; i < blocks_end; i += simd_lanes) {
+                if(prefetch_distance != 0) {
+                    const auto ahead = i + prefetch_distance;
+                    prefetch_indexed<IsScatter>(table, indices, ahead < count ? ahead : count,
+                                                ahead + simd_lanes < count ? ahead + simd_lanes : count);
+                }
+
+                if constexpr (IsScatter) {
+                    scatter_block(src + i, indices + i, dst);
+                } else {
+                    gather_block(src, indices + i, dst + i);
+                }
+            }
+
+            return i;
+        }
+#endif // SBS_SIMD_KERNELS
+
+        template <typename Source, typename Indices, typename Destination>
+        FORCE_INLINE void check_indices(const Source& table, const Indices& indices, const Destination& other) noexcept
+        {
+            #if SBS_ENABLE_DEBUG_ASSERTIONS
+                assert(other.size() >= indices.size());
+
+                // only data() and size() are required of the containers, so don't use operator[] here
+                for(std::size_t i = 0; i < indices.size(); ++i) {
+                    // negative indices wrap around to huge values, so this catches those too
+                    assert(static_cast<std::size_t>(indices.data()[i]) < table.size());
+                }
+            #else
+                static_cast<void>(table);
+                static_cast<void>(indices);
+                static_cast<void>(other);
+            #endif // SBS_ENABLE_DEBUG_ASSERTIONS
+        }
+    }
+
+    //! \brief  Copies src[indices[i]] into dst[i] for every i in [0, indices.size()).
+    //! \note   Typically src is a large table and dst is an unscoped_stack_vector created with an initial size,
+    //!         i.e. unscoped_stack_vector<T> rows(indices.size(), indices.size()).
+    //! \note   Any container with data() and size() works for each of the parameters.
+    //! \note   If SBS_ENABLE_SIMD_GATHER is defined to 1, uses AVX-512 / AVX2 gather instructions when they're
+    //!         enabled at compile time (e.g. -mavx512f / -mavx2 or /arch:AVX512 / /arch:AVX2; the SBS_SIMD_ARCH and
+    //!         SBS_ENABLE_SIMD_GATHER CMake options do this for the tests and benchmarks), the value type is a
+    //!         trivially copyable 4 or 8 byte type and the index type is a 4 or 8 byte integer. These issue the same
+    //!         loads as the plain loop, so they save instructions rather than cache misses, which is why they're off
+    //!         by default.
+    //! \param  src                The table to read from. Every index must be within it.
+    //! \param  indices            The positions to read, in order.
+    //! \param  dst                Where to write. Must have at least indices.size() elements.
+    //! \param  prefetch_distance  How many elements ahead to prefetch, 0 disables prefetching.
+    template <typename Source, typename Indices, typename Destination>
+    void gather(const Source& src,
+                const Indices& indices,
+                Destination& dst,
+                const std::size_t prefetch_distance = default_prefetch_distance)
+    {
+        using value_type = std::remove_const_t<std::remove_pointer_t<decltype(dst.data())>>;
+        using index_type = std::remove_const_t<std::remove_pointer_t<decltype(indices.data())>>;
+
+        detail::check_indices(src, indices, dst);
+
+        const auto count = indices.size();
+        std::size_t first = 0;
+
+        #if SBS_SIMD_KERNELS && SBS_ENABLE_SIMD_GATHER
+            if constexpr (detail::is_simd_gatherable_v<value_type, index_type>) {
+                first = detail::simd_blocks<false>(src.data(), indices.data(), dst.data(), count, prefetch_distance);
+            }
+        #endif // SBS_SIMD_KERNELS && SBS_ENABLE_SIMD_GATHER
+
+        detail::gather_scalar<value_type, index_type>(src.data(), indices.data(), dst.data(),
+                                                      first, count, prefetch_distance);
+    }
+
+    //! \brief  Copies src[i] into dst[indices[i]] for every i in [0, indices.size()); the inverse of gather.
+    //! \note   If an index repeats, the last write wins (exactly like the plain loop).
+    //! \note   If SBS_ENABLE_SIMD_SCATTER is defined to 1, uses AVX-512 scatter instructions when they're enabled at
+    //!         compile time (-mavx512f or /arch:AVX512; the SBS_SIMD_ARCH and SBS_ENABLE_SIMD_SCATTER CMake options
+    //!         do this for the tests and benchmarks), for the same value and index types as gather. AVX2 has no
+    //!         scatter instruction. Like gather's, these didn't beat the plain loop, which is why they're off by
+    //!         default; the speedup comes from the write prefetching.
+    //! \param  src                Where to read from. Must have at least indices.size() elements.
+    //! \param  indices            The positions to write, in order.
+    //! \param  dst                The table to write to. Every index must be within it.
+    //! \param  prefetch_distance  How many elements ahead to prefetch, 0 disables prefetching.
+    template <typename Source, typename Indices, typename Destination>
+    void scatter(const Source& src,
+                 const Indices& indices,
+                 Destination& dst,
+                 const std::size_t prefetch_distance = default_prefetch_distance)
+    {
+        using value_type = std::remove_const_t<std::remove_pointer_t<decltype(dst.data())>>;
+        using index_type = std::remove_const_t<std::remove_pointer_t<decltype(indices.data())>>;
+
+        detail::check_indices(dst, indices, src);
+
+        const auto count = indices.size();
+        std::size_t first = 0;
+
+        #if SBS_SIMD_KERNELS && SBS_ENABLE_SIMD_SCATTER
+            if constexpr (detail::has_simd_scatter && detail::is_simd_gatherable_v<value_type, index_type>) {
+                first = detail::simd_blocks<true>(src.data(), indices.data(), dst.data(), count, prefetch_distance);
+            }
+        #endif // SBS_SIMD_KERNELS && SBS_ENABLE_SIMD_SCATTER
+
+        detail::scatter_scalar<value_type, index_type>(src.data(), indices.data(), dst.data(),
+                                                       first, count, prefetch_distance);
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "sbs_unscoped_stack_vector.hpp"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sbs {
+    //! \brief  A stack allocated pool of fixed-size nodes, for building per-call lists and trees.
+    //! \note   The memory allocated by this type is not free'd until the enclosing function ends,
+    //!         exactly like unscoped_stack_vector. Live objects are *not* destroyed when the pool goes
+    //!         out of scope, so destroy() anything with a non-trivial destructor yourself.
+    //! \note   Pointers returned by this type are stable; free'd nodes are reused via an intrusive free list.
+    //! \note   This type is not thread safe (if you really need it to be, you'll need to manage this yourself).
+    //! \tparam  T  The value type
+    template <typename T>
+    class unscoped_stack_pool final {
+        // a free node stores the link to the next free node in the same memory the value would use
+        union slot {
+            slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        //! \brief  Creates an instance of unscoped_stack_pool.
+        //! \note   This *must* be inlined, since the scope of the alloca depends on the stack frame.
+        //! \note   This doesn't follow "normal" scoping rules - its memory will be free'd when the enclosing function
+        //!         ends, so be very careful of putting this inside a loop (you may get a stack overflow / worse).
+        //! \param  max_size  The maximum number of live nodes. If this is 0, the behaviour is undefined.
+        //!                   You should also be careful not to blow your stack!
+        FORCE_INLINE
+        explicit constexpr unscoped_stack_pool(const size_type max_size) noexcept
+        : m_data(static_cast<slot*>(alloca(max_size * sizeof(slot)))),
+          m_free_list(nullptr),
+          m_max_size(max_size),
+          m_used(0),
+          m_size(0) {
+            #if SBS_ENABLE_DEBUG_ASSERTIONS
+                assert(max_size != 0);
+                assert(m_data != nullptr);
+
+                // this makes sure the following alignment check is valid, because of the casts it uses
+                static_assert(alignof(slot) <= std::numeric_limits<uintptr_t>::max());
+                assert(reinterpret_cast<uintptr_t>(m_data) % static_cast<uintptr_t>(alignof(slot)) == 0);
+            #endif // SBS_ENABLE_DEBUG_ASSERTIONS
+        }
+
+        // non-copyable
+        unscoped_stack_pool(const unscoped_stack_pool&) = delete;
+        unscoped_stack_pool& operator=(const unscoped_stack_pool&) = delete;
+
+        // non-moveable
+        unscoped_stack_pool(unscoped_stack_pool&&) = delete;
+        unscoped_stack_pool& operator=(unscoped_stack_pool&&) = delete;
+
+        //! \brief  The number of nodes currently allocated.
+        constexpr size_type size() const noexcept { return m_size; }
+        constexpr size_type max_size() const noexcept { return m_max_size; }
+        constexpr bool full() const noexcept { return m_size == m_max_size; }
+
+        //! \brief  Returns storage for one value_type, which has *not* been constructed.
+        //! \note   The pool must not be full().
+        constexpr value_type* allocate() noexcept
+        {
+            #if SBS_ENABLE_DEBUG_ASSERTIONS
+                assert(!full());
+            #endif // SBS_ENABLE_DEBUG_ASSERTIONS
+
+            slot* result;
+
+            // nodes are handed out in address order until the slab is exhausted, only then is the free list used,
+            // so the common build-then-discard pattern never touches it and stays cache friendly
+            if(m_free_list != nullptr) {
+                result = m_free_list;
+                m_free_list = result->next;
+            } else {
+                result = &m_data[m_used++];
+            }
+
+            ++m_size;
+            return reinterpret_cast<value_type*>(result->storage);
+        }
+
+        //! \brief  Returns storage obtained from allocate() to the pool, without destroying it.
+        constexpr void deallocate(value_type* const node) noexcept
+        {
+            #if SBS_ENABLE_DEBUG_ASSERTIONS
+                assert(owns(node));
+                assert(size() != 0);
+            #endif // SBS_ENABLE_DEBUG_ASSERTIONS
+
+            const auto freed = reinterpret_cast<slot*>(node);
+            freed->next = m_free_list;
+            m_free_list = freed;
+            --m_size;
+        }
+
+        //! \brief  Allocates a node and constructs a value_type in it.
+        template <typename ...Args>
+        value_type* emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<value_type, Args...>)
+        {
+            const auto node = allocate();
+
+            if constexpr (std::is_nothrow_constructible_v<value_type, Args...>) {
+                return new(node) value_type(std::forward<Args>(args)...);
+            } else {
+                try {
+                    return new(node) value_type(std::forward<Args>(args)...);
+                } catch(...) {
+                    deallocate(node);
+                    throw;
+                }
+            }
+        }
+
+        //! \brief  Destroys a value created by emplace() and returns its node to the pool.
+        constexpr void destroy(value_type* const node) noexcept(std::is_nothrow_destructible_v<value_type>)
+        {
+            node->~value_type();
+            deallocate(node);
+        }
+
+        //! \brief  Whether the given pointer points to a node inside this pool's slab.
+        bool owns(const value_type* const node) const noexcept
+        {
+            const auto address = reinterpret_cast<uintptr_t>(node);
+            const auto begin = reinterpret_cast<uintptr_t>(m_data);
+            const auto end = reinterpret_cast<uintptr_t>(m_data + m_max_size);
+            return address >= begin && address < end && (address - begin) % sizeof(slot) == 0;
+        }
+
+    private:
+        slot* const m_data;
+        slot* m_free_list;
+        const size_type m_max_size;
+        size_type m_used;
+        size_type m_size;
+    };
+
+    //! \brief  Raw storage big enough for a standard library node holding a T.
+    //! \note   Node-based containers rebind their allocator to an implementation-specific node type, so you can't name
+    //!         it directly. This reserves room for T plus Links pointers, which covers std::list (2) and
+    //!         std::map / std::set (3 plus a colour) on the major implementations. If it isn't enough,
+    //!         unscoped_stack_pool_allocator::allocate will fail to compile rather than corrupt memory.
+    //! \tparam  T      The container's value type (for std::map, std::pair<const Key, Value>)
+    //! \tparam  Links  The number of pointer-sized fields the node adds to T
+    template <typename T, std::size_t Links = 4>
+    struct unscoped_stack_pool_node final {
+        alignas(alignof(T) > alignof(void*) ? alignof(T) : alignof(void*))
+        unsigned char storage[sizeof(T) + Links * sizeof(void*)];
+    };
+
+    //! \brief  An allocator adapter that lets node-based standard containers (std::list, std::map, ...) use an
+    //!         unscoped_stack_pool.
+    //! \note   Only single-object allocations are supported; containers that allocate arrays (std::vector,
+    //!         std::deque, std::unordered_map's buckets) will get std::bad_alloc.
+    //! \note   The container must not outlive the pool, and thus must not outlive the function that created the pool.
+    //! \note   Leave room in the pool for the container's own bookkeeping: some implementations allocate a list
+    //!         sentinel / tree header, and MSVC debug builds also allocate a container proxy, per container.
+    //! \tparam  T     The value type, usually supplied by the container via rebind
+    //! \tparam  Node  The pool's value type, see unscoped_stack_pool_node
+    //! \note   Not final, since some standard library implementations derive from their allocator.
+    template <typename T, typename Node>
+    class unscoped_stack_pool_allocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using pool_type = unscoped_stack_pool<Node>;
+
+        template <typename U>
+        struct rebind {
+            using other = unscoped_stack_pool_allocator<U, Node>;
+        };
+
+        explicit constexpr unscoped_stack_pool_allocator(pool_type& pool) noexcept
+        : m_pool(&pool) { }
+
+        template <typename U>
+        constexpr unscoped_stack_pool_allocator(const unscoped_stack_pool_allocator<U, Node>& other) noexcept
+        : m_pool(other.m_pool) { }
+
+        //! \brief  Allocates storage for one value_type from the pool.
+        //! \note   Throws std::bad_alloc if n != 1 or the pool is full.
+        value_type* allocate(const size_type n)
+        {
+            static_assert(sizeof(value_type) <= sizeof(Node), "Pool nodes are too small for this type, increase Links");
+            static_assert(alignof(value_type) <= alignof(Node), "Pool nodes are under-aligned for this type");
+
+            if(n != 1 || m_pool->full()) {
+                throw std::bad_alloc();
+            }
+
+            return reinterpret_cast<value_type*>(m_pool->allocate());
+        }
+
+        void deallocate(value_type* const p, const size_type) noexcept
+        {
+            m_pool->deallocate(reinterpret_cast<Node*>(p));
+        }
+
+        constexpr pool_type& pool() const noexcept { return *m_pool; }
+
+        template <typename U>
+        constexpr bool operator==(const unscoped_stack_pool_allocator<U, Node>& other) const noexcept
+        {
+            return m_pool == other.m_pool;
+        }
+
+        template <typename U>
+        constexpr bool operator!=(const unscoped_stack_pool_allocator<U, Node>& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        template <typename, typename>
+        friend class unscoped_stack_pool_allocator;
+
+        pool_type* m_pool;
+    };
+}
@@ -0,0 +1,190 @@
+#include "test_sbs.hpp"
+
+#include "sbs_gather_scatter.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using sbs::unscoped_stack_vector;
+
+// value type, index type
+template <typename T> class GatherScatterTest : public ::testing::Test { };
+
+using GatherScatterTypes = ::testing::Types<std::pair<uint32_t, uint32_t>,
+                                            std::pair<uint32_t, int64_t>,
+                                            std::pair<int64_t, int32_t>,
+                                            std::pair<uint64_t, uint64_t>,
+                                            std::pair<float, uint32_t>,
+                                            std::pair<double, int64_t>,
+                                            std::pair<uint16_t, uint32_t>>;
+TYPED_TEST_CASE(GatherScatterTest, GatherScatterTypes);
+
+namespace {
+    // a count that isn't a multiple of any SIMD width, so the scalar tail gets exercised too
+    constexpr size_t index_count = 37;
+
+    template <typename Index>
+    std::vector<Index> make_indices(const size_t table_size) {
+        std::vector<Index> indices;
+        for(size_t i = 0; i < index_count; ++i) {
+            indices.push_back(static_cast<Index>((i * 7919U) % table_size));
+        }
+
+        return indices;
+    }
+
+    // the bare minimum gather / scatter ask of a container
+    template <typename T>
+    struct data_size_view final {
+        T* m_data;
+        size_t m_size;
+
+        T* data() const noexcept { return m_data; }
+        size_t size() const noexcept { return m_size; }
+    };
+}
+
+TYPED_TEST(GatherScatterTest, GatherMatchesPlainLoop) {
+    using value_t = typename TypeParam::first_type;
+    using index_t = typename TypeParam::second_type;
+
+    // GIVEN: a table and some indices into it
+    std::vector<value_t> table;
+    for(size_t i = 0; i < 1000; ++i) {
+        table.push_back(static_cast<value_t>(i * 3 + 1));
+    }
+
+    const auto indices = make_indices<index_t>(table.size());
+
+    for(const size_t distance : {size_t{0}, size_t{1}, sbs::default_prefetch_distance, size_t{1000}}) {
+        // WHEN: gather is called with various prefetch distances
+        unscoped_stack_vector<value_t> rows(index_count, index_count);
+        sbs::gather(table, indices, rows, distance);
+
+        // THEN: each row is the indexed table entry
+        for(size_t i = 0; i < index_count; ++i) {
+            ASSERT_EQ(rows[i], table[static_cast<size_t>(indices[i])]);
+        }
+    }
+}
+
+TYPED_TEST(GatherScatterTest, ScatterMatchesPlainLoop) {
+    using value_t = typename TypeParam::first_type;
+    using index_t = typename TypeParam::second_type;
+
+    // GIVEN: some rows and indices into a table
+    const auto indices = make_indices<index_t>(1000);
+
+    unscoped_stack_vector<value_t> rows(index_count);
+    for(size_t i = 0; i < index_count; ++i) {
+        rows.push_back(static_cast<value_t>(i + 5));
+    }
+
+    for(const size_t distance : {size_t{0}, size_t{1}, sbs::default_prefetch_distance, size_t{1000}}) {
+        // WHEN: scatter is called with various prefetch distances
+        std::vector<value_t> table(1000, value_t{0});
+        sbs::scatter(rows, indices, table, distance);
+
+        // THEN: each indexed table entry is the matching row
+        //       nothing else is touched
+        std::vector<value_t> expected(1000, value_t{0});
+        for(size_t i = 0; i < index_count; ++i) {
+            expected[static_cast<size_t>(indices[i])] = rows[i];
+        }
+
+        ASSERT_EQ(table, expected);
+    }
+}
+
+TYPED_TEST(GatherScatterTest, ScatterRepeatedIndexLastWins) {
+    using value_t = typename TypeParam::first_type;
+    using index_t = typename TypeParam::second_type;
+
+    // GIVEN: 16 indices (a whole number of SIMD blocks, so there's no scalar tail),
+    //        where positions 0 -> 7 (exactly one AVX-512 block) all point to entry 3
+    //        and positions 8 -> 15 point to distinct other entries
+    std::vector<index_t> indices(8, index_t{3});
+    for(size_t i = 8; i < 16; ++i) {
+        indices.push_back(static_cast<index_t>(i + 2));
+    }
+
+    unscoped_stack_vector<value_t> rows(16);
+    for(size_t i = 0; i < 16; ++i) {
+        rows.push_back(static_cast<value_t>(i + 100));
+    }
+
+    // WHEN: scatter is called
+    std::vector<value_t> table(20, value_t{0});
+    sbs::scatter(rows, indices, table);
+
+    // THEN: the last lane of the repeated block is the one that's kept
+    //       the other entries get their own rows
+    ASSERT_EQ(table[3], static_cast<value_t>(107));
+    for(size_t i = 8; i < 16; ++i) {
+        ASSERT_EQ(table[i + 2], rows[i]);
+    }
+}
+
+TEST(GatherScatterTest, NonTrivialType) {
+    // GIVEN: a table of a type the SIMD kernels can't handle
+    const std::vector<std::string> table{"zero", "one", "two", "three"};
+    const std::vector<uint32_t> indices{3, 1, 1, 0};
+
+    // WHEN: gather is called
+    unscoped_stack_vector<std::string> rows(4, 4);
+    sbs::gather(table, indices, rows);
+
+    // THEN: each row is the indexed table entry
+    ASSERT_EQ(rows[0], "three");
+    ASSERT_EQ(rows[1], "one");
+    ASSERT_EQ(rows[2], "one");
+    ASSERT_EQ(rows[3], "zero");
+
+    // WHEN: they're scattered back somewhere else
+    std::vector<std::string> other(4);
+    sbs::scatter(rows, indices, other);
+
+    // THEN: the indexed entries are written
+    ASSERT_EQ(other, (std::vector<std::string>{"zero", "one", "", "three"}));
+}
+
+TEST(GatherScatterTest, EmptyIndices) {
+    // GIVEN: no indices
+    const std::vector<uint32_t> table{1, 2, 3};
+    const std::vector<uint32_t> indices;
+    std::vector<uint32_t> rows;
+
+    // WHEN: gather and scatter are called
+    // THEN: nothing happens
+    std::vector<uint32_t> other{4, 5, 6};
+    sbs::gather(table, indices, rows);
+    sbs::scatter(table, indices, other);
+    ASSERT_TRUE(rows.empty());
+    ASSERT_EQ(other, (std::vector<uint32_t>{4, 5, 6}));
+}
+
+TEST(GatherScatterTest, DataAndSizeAreEnough) {
+    // GIVEN: views which only provide data() and size()
+    std::vector<uint32_t> tableStorage{10, 11, 12, 13};
+    std::vector<uint32_t> indicesStorage{2, 0, 3};
+    std::vector<uint32_t> rowsStorage(3);
+
+    const data_size_view<uint32_t> table{tableStorage.data(), tableStorage.size()};
+    const data_size_view<const uint32_t> indices{indicesStorage.data(), indicesStorage.size()};
+    data_size_view<uint32_t> rows{rowsStorage.data(), rowsStorage.size()};
+
+    // WHEN: gather is called
+    sbs::gather(table, indices, rows);
+
+    // THEN: each row is the indexed table entry
+    ASSERT_EQ(rowsStorage, (std::vector<uint32_t>{12, 10, 13}));
+
+    // WHEN: scatter is called
+    std::vector<uint32_t> otherStorage(4, 0U);
+    data_size_view<uint32_t> other{otherStorage.data(), otherStorage.size()};
+    sbs::scatter(rows, indices, other);
+
+    // THEN: the indexed entries are written
+    ASSERT_EQ(otherStorage, (std::vector<uint32_t>{10, 0, 12, 13}));
+}
@@ -0,0 +1,280 @@
+#include "test_sbs.hpp"
+
+#include "sbs_unscoped_stack_pool.hpp"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <vector>
+
+using sbs::unscoped_stack_pool;
+using sbs::unscoped_stack_pool_allocator;
+using sbs::unscoped_stack_pool_node;
+
+#ifdef WIN32
+#define NEVER_INLINE __declspec(noinline)
+#else
+#define NEVER_INLINE __attribute__((noinline))
+#endif
+
+namespace {
+    struct TreeNode final
+    {
+        int32_t key;
+        TreeNode* left = nullptr;
+        TreeNode* right = nullptr;
+
+        TreeNode(int32_t k) : key(k) {}
+    };
+
+    void insert(unscoped_stack_pool<TreeNode>& pool, TreeNode*& root, const int32_t key) {
+        TreeNode** target = &root;
+        while(*target != nullptr) {
+            target = key < (*target)->key ? &(*target)->left : &(*target)->right;
+        }
+
+        *target = pool.emplace(key);
+    }
+
+    void in_order(const TreeNode* const node, std::vector<int32_t>& out) {
+        if(node == nullptr) {
+            return;
+        }
+
+        in_order(node->left, out);
+        out.push_back(node->key);
+        in_order(node->right, out);
+    }
+}
+
+TEST(USPTest, AllocateDeallocate) {
+    // GIVEN: an instance with max_size 3
+    unscoped_stack_pool<uint64_t> instance{3};
+
+    // THEN: max_size() returns 3
+    //       size() returns 0
+    ASSERT_EQ(instance.max_size(), 3U);
+    ASSERT_EQ(instance.size(), 0U);
+    ASSERT_FALSE(instance.full());
+
+    // WHEN: 3 nodes are allocated
+    uint64_t* const a = instance.allocate();
+    uint64_t* const b = instance.allocate();
+    uint64_t* const c = instance.allocate();
+
+    // THEN: size() returns 3
+    //       the pool is full
+    //       the nodes are distinct and owned by the pool
+    ASSERT_EQ(instance.size(), 3U);
+    ASSERT_TRUE(instance.full());
+    ASSERT_NE(a, b);
+    ASSERT_NE(b, c);
+    ASSERT_NE(a, c);
+    ASSERT_TRUE(instance.owns(a));
+    ASSERT_TRUE(instance.owns(b));
+    ASSERT_TRUE(instance.owns(c));
+
+    // WHEN: the middle node is deallocated
+    instance.deallocate(b);
+
+    // THEN: size() returns 2
+    ASSERT_EQ(instance.size(), 2U);
+    ASSERT_FALSE(instance.full());
+
+    // WHEN: another node is allocated
+    uint64_t* const d = instance.allocate();
+
+    // THEN: the free'd node is reused
+    ASSERT_EQ(d, b);
+    ASSERT_EQ(instance.size(), 3U);
+}
+
+TEST(USPTest, PointersStable) {
+    // GIVEN: an instance with max_size 4 and two live values
+    unscoped_stack_pool<int32_t> instance{4};
+    int32_t* const a = instance.emplace(1);
+    int32_t* const b = instance.emplace(2);
+
+    // WHEN: further values are created and destroyed
+    instance.destroy(instance.emplace(3));
+    int32_t* const c = instance.emplace(4);
+    instance.destroy(c);
+
+    // THEN: the original values are untouched
+    ASSERT_EQ(*a, 1);
+    ASSERT_EQ(*b, 2);
+    ASSERT_EQ(instance.size(), 2U);
+}
+
+TEST(USPTest, OwnsRejectsForeignPointers) {
+    // GIVEN: an instance and a value living elsewhere
+    unscoped_stack_pool<int64_t> instance{2};
+    int64_t elsewhere = 0;
+
+    // THEN: owns() returns false for it
+    ASSERT_FALSE(instance.owns(&elsewhere));
+}
+
+TEST(USPTest, DtorCalled) {
+    bool dtorCalled = false;
+
+    struct TypeWithDtor final
+    {
+        bool& m_called;
+
+        TypeWithDtor(bool& called) : m_called(called) {}
+        ~TypeWithDtor() { m_called = true; }
+    };
+
+    // GIVEN: an instance holding a value with a destructor
+    unscoped_stack_pool<TypeWithDtor> instance{1};
+    TypeWithDtor* const value = instance.emplace(dtorCalled);
+    ASSERT_FALSE(dtorCalled);
+
+    // WHEN: destroy() is called
+    instance.destroy(value);
+
+    // THEN: the destructor is called and the node is returned
+    ASSERT_TRUE(dtorCalled);
+    ASSERT_EQ(instance.size(), 0U);
+}
+
+TEST(USPTest, ThrowingCtorReturnsNode) {
+    struct Throws final
+    {
+        Throws(int32_t) { throw std::runtime_error("nope"); }
+    };
+
+    // GIVEN: an instance with max_size 1
+    unscoped_stack_pool<Throws> instance{1};
+
+    // WHEN: emplace() throws
+    ASSERT_THROW(instance.emplace(1), std::runtime_error);
+
+    // THEN: the node is returned to the pool
+    ASSERT_EQ(instance.size(), 0U);
+}
+
+TEST(USPTest, BinaryTree) {
+    // GIVEN: a tree built from pool nodes
+    unscoped_stack_pool<TreeNode> pool{8};
+    TreeNode* root = nullptr;
+
+    for(const auto key : {5, 3, 8, 1, 4, 7, 9, 2}) {
+        insert(pool, root, key);
+    }
+
+    // THEN: traversing it gives the keys in order
+    std::vector<int32_t> keys;
+    in_order(root, keys);
+    ASSERT_EQ(keys, (std::vector<int32_t>{1, 2, 3, 4, 5, 7, 8, 9}));
+    ASSERT_TRUE(pool.full());
+}
+
+TEST(USPTest, StdList) {
+    using node_t = unscoped_stack_pool_node<int32_t>;
+    using allocator_t = unscoped_stack_pool_allocator<int32_t, node_t>;
+
+    // GIVEN: a std::list using a pool with max_size 8
+    unscoped_stack_pool<node_t> pool{8};
+    std::list<int32_t, allocator_t> instance{allocator_t{pool}};
+
+    // WHEN: values are pushed
+    instance.push_back(1);
+    instance.push_back(2);
+    instance.push_front(0);
+
+    // THEN: the nodes come from the pool
+    //       the list contains the specified values
+    ASSERT_GE(pool.size(), 3U);
+    // (compared against a vector so the check doesn't take more nodes from the pool)
+    const std::vector<int32_t> expected{0, 1, 2};
+    ASSERT_EQ(instance.size(), expected.size());
+    ASSERT_TRUE(std::equal(instance.begin(), instance.end(), expected.begin()));
+
+    // WHEN: the list is cleared
+    const auto before = pool.size();
+    instance.clear();
+
+    // THEN: the nodes are returned to the pool
+    ASSERT_EQ(pool.size(), before - 3U);
+}
+
+TEST(USPTest, StdMap) {
+    using value_t = std::pair<const int32_t, int64_t>;
+    using node_t = unscoped_stack_pool_node<value_t>;
+    using allocator_t = unscoped_stack_pool_allocator<value_t, node_t>;
+
+    // GIVEN: a std::map using a pool with max_size 16
+    unscoped_stack_pool<node_t> pool{16};
+    std::map<int32_t, int64_t, std::less<int32_t>, allocator_t> instance{allocator_t{pool}};
+
+    // WHEN: values are inserted
+    for(int32_t i = 10; i > 0; --i) {
+        instance.emplace(i, i * 100);
+    }
+
+    // THEN: the map contains them, in order
+    ASSERT_EQ(instance.size(), 10U);
+    int32_t expected = 1;
+    for(const auto& [key, value] : instance) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value, expected * 100);
+        ++expected;
+    }
+
+    // WHEN: a value is erased
+    const auto before = pool.size();
+    instance.erase(5);
+
+    // THEN: its node is returned to the pool
+    ASSERT_EQ(pool.size(), before - 1U);
+}
+
+TEST(USPTest, AllocatorThrowsWhenFull) {
+    using node_t = unscoped_stack_pool_node<int32_t>;
+    using allocator_t = unscoped_stack_pool_allocator<int32_t, node_t>;
+
+    // GIVEN: a full pool
+    unscoped_stack_pool<node_t> pool{1};
+    allocator_t allocator{pool};
+    int32_t* const only = allocator.allocate(1);
+
+    // THEN: allocating from it throws std::bad_alloc
+    ASSERT_THROW(allocator.allocate(1), std::bad_alloc);
+
+    // THEN: array allocations throw std::bad_alloc
+    allocator.deallocate(only, 1);
+    ASSERT_THROW(allocator.allocate(2), std::bad_alloc);
+}
+
+TEST(USPTest, AllocatorEquality) {
+    using node_t = unscoped_stack_pool_node<int32_t>;
+
+    // GIVEN: two pools
+    unscoped_stack_pool<node_t> first{1};
+    unscoped_stack_pool<node_t> second{1};
+
+    // THEN: allocators are equal if and only if they share a pool, regardless of value type
+    const unscoped_stack_pool_allocator<int32_t, node_t> a{first};
+    const unscoped_stack_pool_allocator<int16_t, node_t> b{a};
+    const unscoped_stack_pool_allocator<int32_t, node_t> c{second};
+    ASSERT_TRUE(a == b);
+    ASSERT_FALSE(a != b);
+    ASSERT_TRUE(a != c);
+    ASSERT_EQ(&b.pool(), &first);
+}
+
+NEVER_INLINE
+void allocate_one_pool(const size_t size) {
+    unscoped_stack_pool<uint64_t> instance(size);
+    *instance.allocate() = 0;
+}
+
+TEST(USPTest, StackOverflow) {
+    // the memory allocated by this type should be free'd when the stack frame ends,
+    // if it doesn't you will hopefully get a stack overflow here
+    for(size_t i = 0; i < 10000000; ++i) {
+        allocate_one_pool(1000);
+    }
+}